@@ -280,17 +280,24 @@ Quality: ${selectedQuality.value}''');
       }
 
       String albumArtUri = _apiService.getAlbumArtUrl(track.id);
-      _audioHandler.updateItem(track, albumArtUri);
+      _audioHandler.updateItem(
+        track,
+        albumArtUri,
+        artHeaders: artHeaders,
+      );
 
       _playTrackController.add(track);
       notifyListeners();
 
       _lastError = null;
 
+      final headers = 'Authorization: Bearer $token\r\n';
       await _player.load(
         url,
-        headers: 'Authorization: Bearer $token\r\n',
+        headers: headers,
+        hints: _loadHints(track, selectedQuality),
       );
+      _updateHeadWindow(selectedQuality, headers);
 
       if (isRecovery && _optimisticPosition != null && _optimisticPosition!.inSeconds > 0) {
         logger.d('Waiting for stream to load before seeking to ${_optimisticPosition!.inSeconds}...');
@@ -380,6 +387,7 @@ Quality: ${selectedQuality.value}''');
     _currentIndex = -1;
     _currentTrack = null;
     _player.stop();
+    _player.setHeadWindow(const []);
     notifyListeners();
   }
 
@@ -417,6 +425,72 @@ Quality: ${selectedQuality.value}''');
     notifyListeners();
   }
 
+  /// Decodes the start of the tracks a skip would go to, so they play at
+  /// once. Neighbours are assumed to play at the current track's quality,
+  /// one that resolves differently only misses the cache.
+  void _updateHeadWindow(Quality quality, String headers) {
+    final urls = <String>[];
+    for (final index in [_currentIndex + 1, _currentIndex - 1, _currentIndex + 2]) {
+      if (index >= 0 && index < _queue.length) {
+        urls.add(_apiService.getStreamUrl(_queue[index].id, quality));
+      }
+    }
+    _player.setHeadWindow(urls, headers: headers);
+  }
+
+  /// What the backend serves for each tier (see pretranscode), so the
+  /// decoder can skip probing. Auto switches variants, so it gets none.
+  LoadHints? _loadHints(models.Track track, Quality quality) {
+    final duration = track.duration > 0
+        ? Duration(seconds: track.duration)
+        : null;
+    final trackId = '${track.id}:${quality.value}';
+    switch (quality) {
+      case Quality.auto:
+        return null;
+      case Quality.efficiency:
+      case Quality.high:
+        return LoadHints(
+          trackId: trackId,
+          codec: 'opus',
+          sampleRate: 48000,
+          duration: duration,
+        );
+      case Quality.cd:
+        return LoadHints(
+          trackId: trackId,
+          codec: 'flac',
+          sampleRate: 44100,
+          duration: duration,
+        );
+      case Quality.hires:
+        return LoadHints(
+          trackId: trackId,
+          codec: 'flac',
+          sampleRate: track.sampleRate ?? 0,
+          duration: duration,
+        );
+    }
+  }
+
+  String albumArtUrl(models.Track track) =>
+      _apiService.getAlbumArtUrl(track.id);
+
+  Map<String, String> get artHeaders => _apiService.headers;
+
+  /// Catches up after the Linux media session played or paused the player
+  /// natively, so a paused player is not mistaken for a stall.
+  void syncPlaying(bool playing) {
+    _userPaused = !playing;
+    notifyListeners();
+  }
+
+  /// Catches up after the Linux media session seeked the player natively.
+  void syncSeeked(Duration position) {
+    _seekController.add(position);
+    notifyListeners();
+  }
+
   bool _trackEndHandled = false;
 
   void _handleTrackEnd() async {
@@ -441,6 +515,21 @@ Quality: ${selectedQuality.value}''');
     notifyListeners();
   }
 
+  void scrubBegin() {
+    _player.scrubBegin();
+  }
+
+  void scrubUpdate(Duration position) {
+    _player.scrubUpdate(position);
+    notifyListeners();
+  }
+
+  void scrubEnd(Duration position) {
+    _player.scrubEnd(position);
+    _seekController.add(position);
+    notifyListeners();
+  }
+
   Future<void> restartCurrentTrack({bool isRecovery = false}) async {
     if (_currentTrack != null) {
       if (isRecovery) {
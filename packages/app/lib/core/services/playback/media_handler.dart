@@ -94,13 +94,14 @@ class MediaSessionHandler extends BaseAudioHandler with SeekHandler {
         MediaAction.seek,
         MediaAction.seekForward,
         MediaAction.seekBackward,
+        MediaAction.setSpeed,
       },
       androidCompactActionIndices: const [0, 1, 2],
       processingState: processingState,
       playing: _playing.value,
       updatePosition: overridePosition ?? player.position,
       bufferedPosition: Duration.zero,
-      speed: 1.0,
+      speed: player.rate,
     );
   }
 
@@ -108,7 +109,11 @@ class MediaSessionHandler extends BaseAudioHandler with SeekHandler {
     playbackState.add(_mapPlayerStateToPlaybackState(overridePosition));
   }
 
-  void updateItem(Track track, String artUri) {
+  void updateItem(
+    Track track,
+    String artUri, {
+    Map<String, String>? artHeaders,
+  }) {
     mediaItem.add(
       MediaItem(
         id: track.id,
@@ -117,6 +122,7 @@ class MediaSessionHandler extends BaseAudioHandler with SeekHandler {
         artist: track.artist,
         duration: player.duration,
         artUri: Uri.parse(artUri),
+        artHeaders: artHeaders,
       ),
     );
 
@@ -153,6 +159,12 @@ class MediaSessionHandler extends BaseAudioHandler with SeekHandler {
     _broadcastState(position);
   }
 
+  @override
+  Future<void> setSpeed(double speed) async {
+    player.setRate(speed);
+    _broadcastState();
+  }
+
   @override
   Future<void> stop() async {
     player.stop();
@@ -2,40 +2,45 @@ import 'dart:io';
 
 import 'package:audio_service/audio_service.dart';
 import 'package:flutter/services.dart';
+import 'package:http/http.dart' as http;
 import 'package:sonic_atlas/core/services/playback/audio.dart' as sa_audio;
+import 'package:sonic_atlas/core/services/utils/logger.dart';
 
 class LinuxMprisManager {
   static const MethodChannel _channel = MethodChannel('sonic_atlas/mpris');
   final AudioHandler audioHandler;
   final sa_audio.AudioService? _audioService;
+  final Set<String> _artRequests = {};
 
   LinuxMprisManager(this.audioHandler, [this._audioService]) {
     if (!Platform.isLinux) return;
 
+    // Playback status, position and rate are read from the player natively,
+    // only metadata is pushed from here.
     _channel.setMethodCallHandler(_handleMethodCall);
 
-    audioHandler.playbackState.listen((state) {
-      updateState(
-        playing: state.playing,
-        position: state.position.inMicroseconds,
-        speed: state.speed,
-      );
-    });
-
     audioHandler.mediaItem.listen((item) {
       if (item != null) {
         updateMetadata(item);
+        _cacheArt(item.id, item.artUri?.toString(), item.artHeaders);
+        _prefetchNextArt();
       }
     });
   }
 
+  // Play, pause and seek have already been applied to the player natively,
+  // these only bring the Dart side up to date.
   Future<void> _handleMethodCall(MethodCall call) async {
     switch (call.method) {
-      case 'onPlay':
-        audioHandler.play();
+      case 'onPlayed':
+        _audioService?.syncPlaying(true);
         break;
-      case 'onPause':
-        audioHandler.pause();
+      case 'onPaused':
+        _audioService?.syncPlaying(false);
+        break;
+      case 'onStopped':
+        _audioService?.syncPlaying(false);
+        audioHandler.stop();
         break;
       case 'onNext':
         audioHandler.skipToNext();
@@ -43,46 +48,52 @@ class LinuxMprisManager {
       case 'onPrevious':
         audioHandler.skipToPrevious();
         break;
-      case 'onSeek':
-        final int offsetUs = call.arguments;
-        final currentPosition = audioHandler.playbackState.value.position;
-        final newPosition = currentPosition + Duration(microseconds: offsetUs);
-        if (_audioService != null) {
-          _audioService.seek(newPosition);
-        } else {
-          audioHandler.seek(newPosition);
-        }
-        break;
-      case 'onSetPosition':
+      case 'onSeeked':
         final int positionUs = call.arguments;
-        if (_audioService != null) {
-          _audioService.seek(Duration(microseconds: positionUs));
-        } else {
-          audioHandler.seek(Duration(microseconds: positionUs));
-        }
+        _audioService?.syncSeeked(Duration(microseconds: positionUs));
         break;
     }
   }
 
-  void updateState({
-    required bool playing,
-    required int position,
-    required double speed,
-  }) {
-    _channel.invokeMethod('updateState', {
-      'playing': playing,
-      'position': position,
-      'speed': speed,
-    });
-  }
-
   void updateMetadata(MediaItem item) {
     _channel.invokeMethod('updateMetadata', {
       'title': item.title,
       'artist': item.artist ?? '',
       'album': item.album ?? '',
-      'artUrl': item.artUri?.toString() ?? '',
+      'artKey': item.artUri != null ? item.id : '',
       'duration': item.duration?.inMicroseconds ?? 0,
     });
   }
+
+  void _prefetchNextArt() {
+    final service = _audioService;
+    if (service == null || !service.hasNext) return;
+    final next = service.queue[service.currentIndex + 1];
+    _cacheArt(next.id, service.albumArtUrl(next), service.artHeaders);
+  }
+
+  // The runner keeps a downscaled copy on disk and advertises that to the
+  // desktop, which has no credentials for the original.
+  Future<void> _cacheArt(
+    String key,
+    String? url,
+    Map<String, String>? headers,
+  ) async {
+    if (url == null || url.isEmpty || !_artRequests.add(key)) return;
+    try {
+      final cached = await _channel.invokeMethod<bool>('hasArt', {'key': key});
+      if (cached == true) return;
+
+      final response = await http.get(Uri.parse(url), headers: headers);
+      if (response.statusCode != 200) return;
+      await _channel.invokeMethod('storeArt', {
+        'key': key,
+        'bytes': response.bodyBytes,
+      });
+    } catch (e) {
+      logger.w('Failed to cache cover art for MPRIS', error: e);
+    } finally {
+      _artRequests.remove(key);
+    }
+  }
 }
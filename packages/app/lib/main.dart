@@ -4,6 +4,7 @@ import 'dart:ui';
 import 'package:audio_service/audio_service.dart' as audio_service;
 import 'package:flutter/material.dart';
 import 'package:provider/provider.dart';
+import 'package:sonic_audio/sonic_audio.dart' show MemoryPressure;
 import 'package:windows_single_instance/windows_single_instance.dart';
 
 import 'core/services/network/api.dart';
@@ -127,13 +128,20 @@ class SonicAtlasApp extends StatefulWidget {
   State<SonicAtlasApp> createState() => _SonicAtlasAppState();
 }
 
-class _SonicAtlasAppState extends State<SonicAtlasApp> {
+class _SonicAtlasAppState extends State<SonicAtlasApp>
+    with WidgetsBindingObserver {
   late final AppLifecycleListener _listener;
 
   @override
   void initState() {
     super.initState();
+    WidgetsBinding.instance.addObserver(this);
     _listener = AppLifecycleListener(
+      onResume: () {
+        if (mounted) {
+          context.read<AudioService>().player.onMemoryPressure(MemoryPressure.none);
+        }
+      },
       onExitRequested: () async {
         if (mounted) {
           final audioService = context.read<AudioService>();
@@ -146,8 +154,15 @@ class _SonicAtlasAppState extends State<SonicAtlasApp> {
     );
   }
 
+  @override
+  void didHaveMemoryPressure() {
+    // The OS only warns once, buffers stay small until the app comes back to the foreground
+    context.read<AudioService>().player.onMemoryPressure(MemoryPressure.moderate);
+  }
+
   @override
   void dispose() {
+    WidgetsBinding.instance.removeObserver(this);
     _listener.dispose();
     super.dispose();
   }
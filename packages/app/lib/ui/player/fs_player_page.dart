@@ -541,8 +541,16 @@ class _FullScreenPlayerPageState extends State<FullScreenPlayerPage> {
                               value: position.inMilliseconds.clamp(0, duration.inMilliseconds).toDouble(),
                               min: 0,
                               max: duration.inMilliseconds.toDouble(),
+                              onChangeStart: (_) {
+                                audioService.scrubBegin();
+                              },
                               onChanged: (value) {
-                                audioService.seek(
+                                audioService.scrubUpdate(
+                                  Duration(milliseconds: value.round()),
+                                );
+                              },
+                              onChangeEnd: (value) {
+                                audioService.scrubEnd(
                                   Duration(milliseconds: value.round()),
                                 );
                               },
@@ -0,0 +1,237 @@
+#include "art_cache.h"
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+#include <utime.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ART_CACHE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ART_CACHE_NEON 1
+#endif
+
+// Workers for different tracks can finish together, only one of them walks the directory at a time
+G_LOCK_DEFINE_STATIC(art_cache_evict);
+
+struct StoreJob {
+    std::string key;
+    std::string path;
+    std::string dir;
+    int64_t max_bytes;
+    int size;
+    GBytes *bytes;
+};
+
+static void FreeStoreJob(gpointer data) {
+    auto *job = static_cast<StoreJob *>(data);
+    g_bytes_unref(job->bytes);
+    delete job;
+}
+
+// Halves an RGBA image both ways by averaging each 2x2 block, width and height are the output's. Repeated halving
+// does most of a large reduction cheaply, gdk-pixbuf only filters the last step to the exact size.
+static void HalveRgba(const guchar *src, int src_stride, guchar *dst, int dst_stride, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        const guchar *row0 = src + (size_t)(2 * y) * src_stride;
+        const guchar *row1 = row0 + src_stride;
+        guchar *out = dst + (size_t)y * dst_stride;
+        int x = 0;
+
+#if defined(ART_CACHE_SSE2)
+        for (; x + 4 <= width; x += 4) {
+            const guchar *p0 = row0 + x * 8;
+            const guchar *p1 = row1 + x * 8;
+            __m128i a = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)p0), _mm_loadu_si128((const __m128i *)p1));
+            __m128i b = _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(p0 + 16)),
+                                     _mm_loadu_si128((const __m128i *)(p1 + 16)));
+            // Even pixels to the low half, odd to the high half
+            a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+            __m128i avg = _mm_avg_epu8(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+            _mm_storeu_si128((__m128i *)(out + x * 4), avg);
+        }
+#elif defined(ART_CACHE_NEON)
+        for (; x + 4 <= width; x += 4) {
+            const guchar *p0 = row0 + x * 8;
+            const guchar *p1 = row1 + x * 8;
+            uint8x16_t a = vrhaddq_u8(vld1q_u8(p0), vld1q_u8(p1));
+            uint8x16_t b = vrhaddq_u8(vld1q_u8(p0 + 16), vld1q_u8(p1 + 16));
+            uint32x4x2_t pixels = vuzpq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b));
+            vst1q_u8(out + x * 4,
+                     vrhaddq_u8(vreinterpretq_u8_u32(pixels.val[0]), vreinterpretq_u8_u32(pixels.val[1])));
+        }
+#endif
+
+        for (; x < width; x++) {
+            for (int c = 0; c < 4; c++) {
+                int i = x * 8 + c;
+                out[x * 4 + c] = (guchar)((row0[i] + row0[i + 4] + row1[i] + row1[i + 4] + 2) >> 2);
+            }
+        }
+    }
+}
+
+// Fits the longest side to size, never scaling up
+static GdkPixbuf *Downscale(GdkPixbuf *source, int size) {
+    GdkPixbuf *image = gdk_pixbuf_get_has_alpha(source) ? GDK_PIXBUF(g_object_ref(source))
+                                                        : gdk_pixbuf_add_alpha(source, FALSE, 0, 0, 0);
+    if (!image) return nullptr;
+
+    int width = gdk_pixbuf_get_width(image);
+    int height = gdk_pixbuf_get_height(image);
+    while (std::max(width, height) / 2 >= size && std::min(width, height) >= 2) {
+        GdkPixbuf *half = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width / 2, height / 2);
+        if (!half) break;
+        HalveRgba(gdk_pixbuf_read_pixels(image), gdk_pixbuf_get_rowstride(image), gdk_pixbuf_get_pixels(half),
+                  gdk_pixbuf_get_rowstride(half), width / 2, height / 2);
+        g_object_unref(image);
+        image = half;
+        width /= 2;
+        height /= 2;
+    }
+
+    if (width > size || height > size) {
+        double scale = (double)size / std::max(width, height);
+        int scaled_width = std::max(1, (int)(width * scale + 0.5));
+        int scaled_height = std::max(1, (int)(height * scale + 0.5));
+        GdkPixbuf *scaled = gdk_pixbuf_scale_simple(image, scaled_width, scaled_height, GDK_INTERP_BILINEAR);
+        if (scaled) {
+            g_object_unref(image);
+            image = scaled;
+        }
+    }
+    return image;
+}
+
+// Drops the least recently used files until the directory fits max_bytes
+static void Evict(const std::string &dir, int64_t max_bytes) {
+    struct Entry {
+        std::string path;
+        int64_t size;
+        time_t used;
+    };
+
+    G_LOCK(art_cache_evict);
+    GDir *handle = g_dir_open(dir.c_str(), 0, nullptr);
+    if (handle) {
+        std::vector<Entry> entries;
+        int64_t total = 0;
+        const gchar *name;
+        while ((name = g_dir_read_name(handle)) != nullptr) {
+            if (!g_str_has_suffix(name, ".png")) continue;
+            std::string path = dir + G_DIR_SEPARATOR_S + name;
+            GStatBuf st;
+            if (g_stat(path.c_str(), &st) != 0) continue;
+            entries.push_back({path, (int64_t)st.st_size, st.st_mtime});
+            total += st.st_size;
+        }
+        g_dir_close(handle);
+
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+        for (const Entry &entry : entries) {
+            if (total <= max_bytes) break;
+            if (g_remove(entry.path.c_str()) == 0) total -= entry.size;
+        }
+    }
+    G_UNLOCK(art_cache_evict);
+}
+
+ArtCache::ArtCache(const std::string &dir, int64_t max_bytes, int size)
+    : _dir(dir), _max_bytes(max_bytes), _size(size), _cancellable(g_cancellable_new()) {
+    if (g_mkdir_with_parents(_dir.c_str(), 0700) != 0) {
+        std::cerr << "Art cache: could not create " << _dir << std::endl;
+    }
+}
+
+ArtCache::~ArtCache() {
+    // Workers still running finish on their own but no longer call back
+    g_cancellable_cancel(_cancellable);
+    g_object_unref(_cancellable);
+}
+
+void ArtCache::SetReadyHandler(ArtReadyCallback h) { _ready_callback = h; }
+
+std::string ArtCache::PathFor(const std::string &key) const {
+    gchar *digest = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key.c_str(), -1);
+    std::string path = _dir + G_DIR_SEPARATOR_S + digest + ".png";
+    g_free(digest);
+    return path;
+}
+
+std::string ArtCache::Lookup(const std::string &key) {
+    if (key.empty()) return "";
+    std::string path = PathFor(key);
+    if (!g_file_test(path.c_str(), G_FILE_TEST_IS_REGULAR)) return "";
+
+    utime(path.c_str(), nullptr);
+    gchar *uri = g_filename_to_uri(path.c_str(), nullptr, nullptr);
+    std::string result = uri ? uri : "";
+    g_free(uri);
+    return result;
+}
+
+void ArtCache::Store(const std::string &key, const uint8_t *data, size_t length) {
+    if (key.empty() || !data || length == 0) return;
+
+    auto *job = new StoreJob{key, PathFor(key), _dir, _max_bytes, _size, g_bytes_new(data, length)};
+    GTask *task = g_task_new(nullptr, _cancellable, &ArtCache::OnStored, this);
+    g_task_set_task_data(task, job, FreeStoreJob);
+    g_task_run_in_thread(task, &ArtCache::StoreInThread);
+    g_object_unref(task);
+}
+
+void ArtCache::StoreInThread(GTask *task, gpointer source, gpointer task_data, GCancellable *cancellable) {
+    auto *job = static_cast<StoreJob *>(task_data);
+    GError *error = nullptr;
+
+    gsize length = 0;
+    const guchar *data = static_cast<const guchar *>(g_bytes_get_data(job->bytes, &length));
+    GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
+    gboolean loaded = gdk_pixbuf_loader_write(loader, data, length, &error);
+    loaded = gdk_pixbuf_loader_close(loader, loaded ? &error : nullptr) && loaded;
+    GdkPixbuf *decoded = loaded ? gdk_pixbuf_loader_get_pixbuf(loader) : nullptr;
+    GdkPixbuf *image = decoded ? Downscale(decoded, job->size) : nullptr;
+    g_object_unref(loader);
+
+    if (!image) {
+        if (!error) error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Could not decode artwork");
+        g_task_return_error(task, error);
+        return;
+    }
+
+    // Written aside and renamed so a reader never sees half a file
+    std::string partial = job->path + ".part";
+    gboolean saved = gdk_pixbuf_save(image, partial.c_str(), "png", &error, nullptr);
+    g_object_unref(image);
+    if (!saved || g_rename(partial.c_str(), job->path.c_str()) != 0) {
+        g_remove(partial.c_str());
+        if (!error) error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, "Could not write artwork");
+        g_task_return_error(task, error);
+        return;
+    }
+
+    Evict(job->dir, job->max_bytes);
+    g_task_return_pointer(task, g_filename_to_uri(job->path.c_str(), nullptr, nullptr), g_free);
+}
+
+void ArtCache::OnStored(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GTask *task = G_TASK(result);
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto *self = static_cast<ArtCache *>(user_data);
+    auto *job = static_cast<StoreJob *>(g_task_get_task_data(task));
+    GError *error = nullptr;
+    gchar *uri = static_cast<gchar *>(g_task_propagate_pointer(task, &error));
+    if (!uri) {
+        std::cerr << "Art cache: " << (error ? error->message : "store failed") << std::endl;
+        g_clear_error(&error);
+        return;
+    }
+
+    if (self->_ready_callback) self->_ready_callback(job->key, uri);
+    g_free(uri);
+}
@@ -0,0 +1,39 @@
+#ifndef ART_CACHE_H_
+#define ART_CACHE_H_
+
+#include <gio/gio.h>
+#include <functional>
+#include <string>
+
+// Called on the main loop once artwork for key is on disk, with its file:// URI
+using ArtReadyCallback = std::function<void(const std::string &key, const std::string &uri)>;
+
+// Downscaled cover art on disk, so desktop shells read a small local PNG instead of fetching the original over HTTPS.
+// Decoding, resizing and eviction run on GIO worker threads, the least recently used files go first once the cache
+// grows past max_bytes.
+class ArtCache {
+public:
+    ArtCache(const std::string &dir, int64_t max_bytes, int size);
+    ~ArtCache();
+
+    void SetReadyHandler(ArtReadyCallback handler);
+
+    // file:// URI of the cached artwork, marked as recently used, or empty when it is not cached
+    std::string Lookup(const std::string &key);
+
+    void Store(const std::string &key, const uint8_t *data, size_t length);
+
+private:
+    std::string PathFor(const std::string &key) const;
+
+    static void StoreInThread(GTask *task, gpointer source, gpointer task_data, GCancellable *cancellable);
+    static void OnStored(GObject *source, GAsyncResult *result, gpointer user_data);
+
+    std::string _dir;
+    int64_t _max_bytes;
+    int _size;
+    GCancellable *_cancellable;
+    ArtReadyCallback _ready_callback;
+};
+
+#endif
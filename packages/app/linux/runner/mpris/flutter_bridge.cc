@@ -9,10 +9,11 @@ FlutterBridge::FlutterBridge(FlEngine* engine) {
 
     _mpris = std::make_unique<MprisController>("sonic_atlas");
 
-    _mpris->SetSeekHandler([this](int64_t offset) { this->SendEvent("onSeek", fl_value_new_int(offset)); });
-    _mpris->SetPositionHandler([this](int64_t pos) { this->SendEvent("onSetPosition", fl_value_new_int(pos)); });
-    _mpris->SetPlayHandler([this]() { this->SendEvent("onPlay", nullptr); });
-    _mpris->SetPauseHandler([this]() { this->SendEvent("onPause", nullptr); });
+    // The player has already acted on these, Dart only catches up its own bookkeeping
+    _mpris->SetPositionHandler([this](int64_t pos) { this->SendEvent("onSeeked", fl_value_new_int(pos)); });
+    _mpris->SetPlayHandler([this]() { this->SendEvent("onPlayed", nullptr); });
+    _mpris->SetPauseHandler([this]() { this->SendEvent("onPaused", nullptr); });
+    _mpris->SetStopHandler([this]() { this->SendEvent("onStopped", nullptr); });
     _mpris->SetNextHandler([this]() { this->SendEvent("onNext", nullptr); });
     _mpris->SetPreviousHandler([this]() { this->SendEvent("onPrevious", nullptr); });
 }
@@ -29,28 +30,12 @@ void FlutterBridge::HandleMethodCall(FlMethodChannel* channel, FlMethodCall* cal
     const gchar* method = fl_method_call_get_name(call);
     FlValue* args = fl_method_call_get_args(call);
 
-    if (g_strcmp0(method, "updateState") == 0) {
-        if (fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
-            FlValue* playing = fl_value_lookup_string(args, "playing");
-            FlValue* pos = fl_value_lookup_string(args, "position");
-            FlValue* speed = fl_value_lookup_string(args, "speed");
-
-            if (playing && pos && speed) {
-                self->_mpris->UpdatePlaybackState(
-                        fl_value_get_bool(playing),
-                        fl_value_get_int(pos),
-                        fl_value_get_float(speed)
-                );
-            }
-        }
-        fl_method_call_respond_success(call, nullptr, nullptr);
-    }
-    else if (g_strcmp0(method, "updateMetadata") == 0) {
+    if (g_strcmp0(method, "updateMetadata") == 0) {
         if (fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
             FlValue* title = fl_value_lookup_string(args, "title");
             FlValue* artist = fl_value_lookup_string(args, "artist");
             FlValue* album = fl_value_lookup_string(args, "album");
-            FlValue* art = fl_value_lookup_string(args, "artUrl");
+            FlValue* art = fl_value_lookup_string(args, "artKey");
             FlValue* dur = fl_value_lookup_string(args, "duration");
 
             self->_mpris->UpdateMetadata(
@@ -63,6 +48,23 @@ void FlutterBridge::HandleMethodCall(FlMethodChannel* channel, FlMethodCall* cal
         }
         fl_method_call_respond_success(call, nullptr, nullptr);
     }
+    else if (g_strcmp0(method, "hasArt") == 0) {
+        FlValue* key = fl_value_get_type(args) == FL_VALUE_TYPE_MAP ? fl_value_lookup_string(args, "key") : nullptr;
+        bool cached = key && self->_mpris->HasArt(fl_value_get_string(key));
+        g_autoptr(FlValue) result = fl_value_new_bool(cached);
+        fl_method_call_respond_success(call, result, nullptr);
+    }
+    else if (g_strcmp0(method, "storeArt") == 0) {
+        if (fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+            FlValue* key = fl_value_lookup_string(args, "key");
+            FlValue* bytes = fl_value_lookup_string(args, "bytes");
+            if (key && bytes && fl_value_get_type(bytes) == FL_VALUE_TYPE_UINT8_LIST) {
+                self->_mpris->StoreArt(fl_value_get_string(key), fl_value_get_uint8_list(bytes),
+                                       fl_value_get_length(bytes));
+            }
+        }
+        fl_method_call_respond_success(call, nullptr, nullptr);
+    }
     else {
         fl_method_call_respond_not_implemented(call, nullptr);
     }
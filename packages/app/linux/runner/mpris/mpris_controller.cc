@@ -1,6 +1,25 @@
 #include "mpris_controller.h"
+#include <cstdlib>
 #include <iostream>
 
+extern "C" {
+#include "sonic_audio.h"
+}
+
+// Player states, as numbered by sonic_audio_player_get_state()
+constexpr int kStateBuffering = 1;
+constexpr int kStatePlaying = 2;
+constexpr int kStatePaused = 3;
+
+// How often the player is polled, and how far its position may drift from the extrapolated clock before it counts
+// as a seek.
+constexpr guint kPollIntervalMs = 200;
+constexpr int64_t kSeekThresholdUs = 500000;
+
+// Artwork is stored at most kArtSize pixels on its longest side, about 32 MB covers a few hundred tracks
+constexpr int kArtSize = 512;
+constexpr int64_t kArtCacheBytes = 32 * 1024 * 1024;
+
 const gchar* introspection_xml =
         "<node>"
         "  <interface name='org.mpris.MediaPlayer2'>"
@@ -28,6 +47,9 @@ const gchar* introspection_xml =
         "      <arg direction='in' type='o' name='TrackId'/>"
         "      <arg direction='in' type='x' name='Position'/>"
         "    </method>"
+        "    <signal name='Seeked'>"
+        "      <arg name='Position' type='x'/>"
+        "    </signal>"
         "    <property name='PlaybackStatus' type='s' access='read'/>"
         "    <property name='Metadata' type='a{sv}' access='read'/>"
         "    <property name='Position' type='x' access='read'/>"
@@ -41,7 +63,10 @@ const gchar* introspection_xml =
         "  </interface>"
         "</node>";
 
-MprisController::MprisController(const std::string& app_id) : _app_id(app_id) {
+MprisController::MprisController(const std::string& app_id)
+    : _app_id(app_id),
+      _art_cache(std::string(g_get_user_cache_dir()) + "/" + app_id + "/mpris-art", kArtCacheBytes, kArtSize) {
+    _art_cache.SetReadyHandler([this](const std::string& key, const std::string& uri) { OnArtReady(key, uri); });
     _introspection_data = g_dbus_node_info_new_for_xml(introspection_xml, nullptr);
 
     std::string mpris_name = "org.mpris.MediaPlayer2." + _app_id;
@@ -52,9 +77,13 @@ MprisController::MprisController(const std::string& app_id) : _app_id(app_id) {
                                    static_cast<MprisController*>(d)->OnBusAcquired(c, n);
                                },
                                nullptr, nullptr, this, nullptr);
+
+    _last_poll_time = g_get_monotonic_time();
+    _poll_id = g_timeout_add(kPollIntervalMs, &MprisController::Poll, this);
 }
 
 MprisController::~MprisController() {
+    if (_poll_id > 0) g_source_remove(_poll_id);
     if (_owner_id > 0) g_bus_unown_name(_owner_id);
     if (_introspection_data) g_dbus_node_info_unref(_introspection_data);
 }
@@ -103,19 +132,23 @@ void MprisController::HandleMethodCall(GDBusConnection* connection, const gchar*
         g_dbus_method_invocation_return_value(invocation, nullptr);
     }
     else if (g_strcmp0(method_name, "PlayPause") == 0) {
-        if (self->_is_playing) {
-            if (self->_pause_callback) self->_pause_callback();
+        if (sonic_audio_player_get_state() == kStatePlaying) {
+            self->Pause();
         } else {
-            if (self->_play_callback) self->_play_callback();
+            self->Play();
         }
         g_dbus_method_invocation_return_value(invocation, nullptr);
     }
     else if (g_strcmp0(method_name, "Play") == 0) {
-        if (self->_play_callback) self->_play_callback();
+        self->Play();
         g_dbus_method_invocation_return_value(invocation, nullptr);
     }
-    else if (g_strcmp0(method_name, "Pause") == 0 || g_strcmp0(method_name, "Stop") == 0) {
-        if (self->_pause_callback) self->_pause_callback();
+    else if (g_strcmp0(method_name, "Pause") == 0) {
+        self->Pause();
+        g_dbus_method_invocation_return_value(invocation, nullptr);
+    }
+    else if (g_strcmp0(method_name, "Stop") == 0) {
+        self->Stop();
         g_dbus_method_invocation_return_value(invocation, nullptr);
     }
     else if (g_strcmp0(method_name, "Next") == 0) {
@@ -129,14 +162,22 @@ void MprisController::HandleMethodCall(GDBusConnection* connection, const gchar*
     else if (g_strcmp0(method_name, "Seek") == 0) {
         int64_t offset;
         g_variant_get(parameters, "(x)", &offset);
-        if (self->_seek_callback) self->_seek_callback(offset);
+        int64_t target = self->PlayerPositionUs() + offset;
+        int64_t duration = (int64_t)(sonic_audio_player_get_duration() * 1e6);
+        // Seeking past the end moves to the next track, before the start goes to the start
+        if (duration > 0 && target >= duration) {
+            if (self->_next_callback) self->_next_callback();
+        } else {
+            self->SeekTo(target < 0 ? 0 : target);
+        }
         g_dbus_method_invocation_return_value(invocation, nullptr);
     }
     else if (g_strcmp0(method_name, "SetPosition") == 0) {
         const gchar* track_id;
         int64_t position;
-        g_variant_get(parameters, "(ox)", &track_id, &position);
-        if (self->_set_position_callback) self->_set_position_callback(position);
+        g_variant_get(parameters, "(&ox)", &track_id, &position);
+        int64_t duration = (int64_t)(sonic_audio_player_get_duration() * 1e6);
+        if (position >= 0 && (duration <= 0 || position <= duration)) self->SeekTo(position);
         g_dbus_method_invocation_return_value(invocation, nullptr);
     }
 }
@@ -171,35 +212,11 @@ GVariant* MprisController::HandleGetProperty(GDBusConnection* connection, const
 
     // org.mpris.MediaPlayer2.Player properties
     if (g_strcmp0(property_name, "PlaybackStatus") == 0) {
-        return g_variant_new_string(self->_is_playing ? "Playing" : "Paused");
-    }
-    if (g_strcmp0(property_name, "Metadata") == 0) {
-        GVariantBuilder builder;
-        g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
-
-        g_variant_builder_add(&builder, "{sv}", "mpris:trackid", g_variant_new_object_path("/org/mpris/MediaPlayer2/Track/0"));
-        g_variant_builder_add(&builder, "{sv}", "mpris:length", g_variant_new_int64(self->_duration_us));
-        g_variant_builder_add(&builder, "{sv}", "xesam:title", g_variant_new_string(self->_title.c_str()));
-        g_variant_builder_add(&builder, "{sv}", "xesam:album", g_variant_new_string(self->_album.c_str()));
-
-        GVariantBuilder artist_builder;
-        g_variant_builder_init(&artist_builder, G_VARIANT_TYPE("as"));
-        g_variant_builder_add(&artist_builder, "s", self->_artist.c_str());
-        g_variant_builder_add(&builder, "{sv}", "xesam:artist", g_variant_builder_end(&artist_builder));
-
-        if (!self->_art_url.empty()) {
-            g_variant_builder_add(&builder, "{sv}", "mpris:artUrl", g_variant_new_string(self->_art_url.c_str()));
-        }
-        return g_variant_builder_end(&builder);
-    }
-    if (g_strcmp0(property_name, "Position") == 0) {
-        int64_t current = self->_last_position_us;
-        if (self->_is_playing) {
-            current += (int64_t)((g_get_monotonic_time() - self->_last_update_time) * self->_playback_speed);
-        }
-        return g_variant_new_int64(current);
+        return g_variant_new_string(self->_status.c_str());
     }
-    if (g_strcmp0(property_name, "Rate") == 0) return g_variant_new_double(self->_playback_speed);
+    if (g_strcmp0(property_name, "Metadata") == 0) return self->BuildMetadata();
+    if (g_strcmp0(property_name, "Position") == 0) return g_variant_new_int64(self->PlayerPositionUs());
+    if (g_strcmp0(property_name, "Rate") == 0) return g_variant_new_double(self->_rate);
 
     if (g_strcmp0(property_name, "CanGoNext") == 0 || g_strcmp0(property_name, "CanGoPrevious") == 0 ||
         g_strcmp0(property_name, "CanPlay") == 0 || g_strcmp0(property_name, "CanPause") == 0 ||
@@ -210,62 +227,137 @@ GVariant* MprisController::HandleGetProperty(GDBusConnection* connection, const
     return nullptr;
 }
 
-void MprisController::UpdatePlaybackState(bool playing, int64_t position_us, double speed) {
-    _is_playing = playing;
+void MprisController::Play() {
+    sonic_audio_player_play();
+    if (_play_callback) _play_callback();
+}
+
+void MprisController::Pause() {
+    sonic_audio_player_pause();
+    if (_pause_callback) _pause_callback();
+}
+
+void MprisController::Stop() {
+    // The player goes idle, which the next poll reports as Stopped
+    sonic_audio_player_stop();
+    if (_stop_callback) _stop_callback();
+}
+
+void MprisController::SeekTo(int64_t position_us) {
+    sonic_audio_player_seek(position_us / 1e6);
+
+    // Announced straight away, the poll then measures drift from here and does not report it a second time
     _last_position_us = position_us;
-    _playback_speed = speed;
-    _last_update_time = g_get_monotonic_time();
+    _last_poll_time = g_get_monotonic_time();
+    EmitSeeked(position_us);
+    if (_set_position_callback) _set_position_callback(position_us);
+}
 
-    if (_connection) {
-        int64_t current = _last_position_us;
-        if (_is_playing) {
-            current += (int64_t)((g_get_monotonic_time() - _last_update_time) * _playback_speed);
-        }
+int64_t MprisController::PlayerPositionUs() const {
+    return (int64_t)(sonic_audio_player_get_position() * 1e6);
+}
 
+gboolean MprisController::Poll(gpointer user_data) {
+    auto* self = static_cast<MprisController*>(user_data);
+
+    int state = sonic_audio_player_get_state();
+    double rate = sonic_audio_player_get_rate();
+    if (rate <= 0.0) rate = 1.0;
+    int item = sonic_audio_player_get_current_item();
+    int64_t position = self->PlayerPositionUs();
+    int64_t now = g_get_monotonic_time();
+
+    // Buffering keeps whatever status it interrupted
+    std::string status = self->_status;
+    if (state == kStatePlaying) {
+        status = "Playing";
+    } else if (state == kStatePaused) {
+        status = "Paused";
+    } else if (state != kStateBuffering) {
+        status = "Stopped";
+    }
+
+    // Where the clock would be had playback carried on undisturbed since the last poll. A new item, whether loaded or
+    // reached gaplessly, starts its own clock, which clients learn from the metadata rather than a seek.
+    int64_t expected = self->_last_position_us;
+    if (self->_status == "Playing") expected += (int64_t)((now - self->_last_poll_time) * self->_rate);
+    bool seeked = item == self->_item && std::abs(position - expected) > kSeekThresholdUs;
+
+    if (self->_connection && (status != self->_status || rate != self->_rate)) {
         GVariantBuilder builder;
         g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+        if (status != self->_status) {
+            g_variant_builder_add(&builder, "{sv}", "PlaybackStatus", g_variant_new_string(status.c_str()));
+        }
+        if (rate != self->_rate) g_variant_builder_add(&builder, "{sv}", "Rate", g_variant_new_double(rate));
+        self->EmitPropertiesChanged(&builder);
+    }
 
-        g_variant_builder_add(&builder, "{sv}", "PlaybackStatus", g_variant_new_string(playing ? "Playing" : "Paused"));
-        g_variant_builder_add(&builder, "{sv}", "Position", g_variant_new_int64(current));
-        g_variant_builder_add(&builder, "{sv}", "Rate", g_variant_new_double(_playback_speed));
+    self->_status = status;
+    self->_rate = rate;
+    self->_item = item;
+    self->_last_position_us = position;
+    self->_last_poll_time = now;
 
-        EmitPropertiesChanged(&builder);
-    }
+    if (seeked) self->EmitSeeked(position);
+    return G_SOURCE_CONTINUE;
 }
 
 void MprisController::UpdateMetadata(const std::string& title, const std::string& artist,
-                                     const std::string& album, const std::string& art_url, int64_t duration_us) {
-    if (_title == title && _artist == artist && _duration_us == duration_us && _art_url == art_url) return;
+                                     const std::string& album, const std::string& art_key, int64_t duration_us) {
+    // Only artwork already in the cache is advertised, the rest follows once it is stored
+    std::string art_url = _art_cache.Lookup(art_key);
+    if (_title == title && _artist == artist && _duration_us == duration_us && _art_key == art_key &&
+        _art_url == art_url) {
+        return;
+    }
 
     _title = title;
     _artist = artist;
     _album = album;
+    _art_key = art_key;
     _art_url = art_url;
     _duration_us = duration_us;
+    EmitMetadata();
+}
 
-    if (_connection) {
-        GVariantBuilder builder;
-        g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
-
-        GVariantBuilder meta_builder;
-        g_variant_builder_init(&meta_builder, G_VARIANT_TYPE("a{sv}"));
-        g_variant_builder_add(&meta_builder, "{sv}", "mpris:trackid", g_variant_new_object_path("/org/mpris/MediaPlayer2/Track/0"));
-        g_variant_builder_add(&meta_builder, "{sv}", "mpris:length", g_variant_new_int64(duration_us));
-        g_variant_builder_add(&meta_builder, "{sv}", "xesam:title", g_variant_new_string(title.c_str()));
-        g_variant_builder_add(&meta_builder, "{sv}", "xesam:album", g_variant_new_string(album.c_str()));
+bool MprisController::HasArt(const std::string& art_key) { return !_art_cache.Lookup(art_key).empty(); }
 
-        GVariantBuilder artist_builder;
-        g_variant_builder_init(&artist_builder, G_VARIANT_TYPE("as"));
-        g_variant_builder_add(&artist_builder, "s", artist.c_str());
-        g_variant_builder_add(&meta_builder, "{sv}", "xesam:artist", g_variant_builder_end(&artist_builder));
+void MprisController::StoreArt(const std::string& art_key, const uint8_t* data, size_t length) {
+    _art_cache.Store(art_key, data, length);
+}
 
-        if (!art_url.empty()) {
-            g_variant_builder_add(&meta_builder, "{sv}", "mpris:artUrl", g_variant_new_string(art_url.c_str()));
-        }
+void MprisController::OnArtReady(const std::string& art_key, const std::string& uri) {
+    if (art_key != _art_key || uri == _art_url) return;
+    _art_url = uri;
+    EmitMetadata();
+}
 
-        g_variant_builder_add(&builder, "{sv}", "Metadata", g_variant_builder_end(&meta_builder));
-        EmitPropertiesChanged(&builder);
+GVariant* MprisController::BuildMetadata() const {
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&builder, "{sv}", "mpris:trackid", g_variant_new_object_path("/org/mpris/MediaPlayer2/Track/0"));
+    g_variant_builder_add(&builder, "{sv}", "mpris:length", g_variant_new_int64(_duration_us));
+    g_variant_builder_add(&builder, "{sv}", "xesam:title", g_variant_new_string(_title.c_str()));
+    g_variant_builder_add(&builder, "{sv}", "xesam:album", g_variant_new_string(_album.c_str()));
+
+    GVariantBuilder artist_builder;
+    g_variant_builder_init(&artist_builder, G_VARIANT_TYPE("as"));
+    g_variant_builder_add(&artist_builder, "s", _artist.c_str());
+    g_variant_builder_add(&builder, "{sv}", "xesam:artist", g_variant_builder_end(&artist_builder));
+
+    if (!_art_url.empty()) {
+        g_variant_builder_add(&builder, "{sv}", "mpris:artUrl", g_variant_new_string(_art_url.c_str()));
     }
+    return g_variant_builder_end(&builder);
+}
+
+void MprisController::EmitMetadata() {
+    if (!_connection) return;
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&builder, "{sv}", "Metadata", BuildMetadata());
+    EmitPropertiesChanged(&builder);
 }
 
 void MprisController::EmitPropertiesChanged(GVariantBuilder* builder) {
@@ -274,9 +366,16 @@ void MprisController::EmitPropertiesChanged(GVariantBuilder* builder) {
                                   g_variant_new("(sa{sv}as)", "org.mpris.MediaPlayer2.Player", builder, nullptr), nullptr);
 }
 
-void MprisController::SetSeekHandler(SeekCallback h) { _seek_callback = h; }
+void MprisController::EmitSeeked(int64_t position_us) {
+    if (!_connection) return;
+    g_dbus_connection_emit_signal(_connection, nullptr, "/org/mpris/MediaPlayer2",
+                                  "org.mpris.MediaPlayer2.Player", "Seeked",
+                                  g_variant_new("(x)", position_us), nullptr);
+}
+
 void MprisController::SetPositionHandler(SetPositionCallback h) { _set_position_callback = h; }
 void MprisController::SetPlayHandler(VoidCallback h) { _play_callback = h; }
 void MprisController::SetPauseHandler(VoidCallback h) { _pause_callback = h; }
+void MprisController::SetStopHandler(VoidCallback h) { _stop_callback = h; }
 void MprisController::SetNextHandler(VoidCallback h) { _next_callback = h; }
 void MprisController::SetPreviousHandler(VoidCallback h) { _previous_callback = h; }
\ No newline at end of file
@@ -4,32 +4,50 @@
 #include <gio/gio.h>
 #include <functional>
 #include <string>
+#include "art_cache.h"
 
-// Seek callbacks in microseconds
-using SeekCallback = std::function<void(int64_t)>;
+// Position callbacks in microseconds
 using SetPositionCallback = std::function<void(int64_t)>;
 using VoidCallback = std::function<void()>;
 
+// Play, pause, stop and seek requests drive sonic_audio directly, their handlers are only told afterwards. Playback status,
+// rate and seeks are picked up from the player's state and clock, so nothing has to be pushed from Dart but metadata.
+
 class MprisController {
 public:
     explicit MprisController(const std::string &app_id);
     ~MprisController();
 
-    void SetSeekHandler(SeekCallback handler);
     void SetPositionHandler(SetPositionCallback handler);
     void SetPlayHandler(VoidCallback handler);
     void SetPauseHandler(VoidCallback handler);
+    void SetStopHandler(VoidCallback handler);
     void SetNextHandler(VoidCallback handler);
     void SetPreviousHandler(VoidCallback handler);
 
-    void UpdatePlaybackState(bool playing, int64_t position_us, double speed);
+    // art_key names the track's artwork in the cache, it is advertised as a file:// URI once stored
     void UpdateMetadata(const std::string &title, const std::string &artist,
-                        const std::string &album, const std::string &art_url,
+                        const std::string &album, const std::string &art_key,
                         int64_t duration_us);
 
+    bool HasArt(const std::string &art_key);
+    void StoreArt(const std::string &art_key, const uint8_t *data, size_t length);
+
 private:
     void OnBusAcquired(GDBusConnection *connection, const gchar *name);
     void EmitPropertiesChanged(GVariantBuilder *builder);
+    void EmitSeeked(int64_t position_us);
+    void EmitMetadata();
+    GVariant *BuildMetadata() const;
+    void OnArtReady(const std::string &art_key, const std::string &uri);
+
+    void Play();
+    void Pause();
+    void Stop();
+    void SeekTo(int64_t position_us);
+    int64_t PlayerPositionUs() const;
+
+    static gboolean Poll(gpointer user_data);
 
     static void HandleMethodCall(GDBusConnection *connection,
                                  const gchar *sender,
@@ -53,24 +71,28 @@ private:
     GDBusNodeInfo *_introspection_data;
     GDBusConnection *_connection = nullptr;
     std::string _app_id;
+    ArtCache _art_cache;
 
-    SeekCallback _seek_callback;
     SetPositionCallback _set_position_callback;
     VoidCallback _play_callback;
     VoidCallback _pause_callback;
+    VoidCallback _stop_callback;
     VoidCallback _next_callback;
     VoidCallback _previous_callback;
 
-    // State (time in microseconds)
+    // Last published state, polled from the player (time in microseconds)
+    guint _poll_id = 0;
+    std::string _status = "Stopped";
+    double _rate = 1.0;
+    int _item = -1;
     int64_t _last_position_us = 0;
-    int64_t _last_update_time = 0;
-    bool _is_playing = false;
-    double _playback_speed = 1.0;
+    int64_t _last_poll_time = 0;
 
     // Metadata
     std::string _title;
     std::string _artist;
     std::string _album;
+    std::string _art_key;
     std::string _art_url;
     int64_t _duration_us = 0;
 };
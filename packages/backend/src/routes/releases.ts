@@ -12,9 +12,12 @@ import fsp from 'node:fs/promises';
 import { $rootDir } from '@sonic-atlas/shared';
 import { ImageService } from '../services/ImageService.ts';
 import { processTrackFile } from '../utils/processTrackFile.ts';
+import { mapPool } from '../utils/probeTrack.ts';
 
 const router = Router();
 
+const MAX_CONCURRENT_UPLOAD_FILES = Number(process.env.MAX_CONCURRENT_UPLOAD_FILES) || 4;
+
 // GET /api/releases/:id/cover
 router.get('/:id/cover', async (req, res) => {
     const { id } = req.params;
@@ -230,26 +233,36 @@ router.post('/upload', uploadFields, async (req, res) => {
             }
         }
 
-        const processedTracks: any[] = [];
+        const results = await mapPool(files, MAX_CONCURRENT_UPLOAD_FILES, (file) => processTrackFile({
+            filePath: file.path,
+            originalFilename: file.originalname,
+            releaseId: newRelease.id,
+            primaryArtist,
+            releaseTitle,
+            year,
+            socketId,
+            extractAllCovers: shouldExtractAllCovers,
+            existingReleaseCoverPath: newRelease.coverArtPath,
+            deferReleaseCover: true,
+        }));
 
-        for (const file of files) {
-            const result = await processTrackFile({
-                filePath: file.path,
-                originalFilename: file.originalname,
-                releaseId: newRelease.id,
-                primaryArtist,
-                releaseTitle,
-                year,
-                socketId,
-                extractAllCovers: shouldExtractAllCovers,
-                existingReleaseCoverPath: newRelease.coverArtPath,
-            });
+        const processedTracks = results.flatMap((result) => result ? [result.track] : []);
 
-            if (result) {
-                processedTracks.push(result.track);
-                if (result.releaseCoverUrl) {
-                    newRelease.coverArtPath = result.releaseCoverUrl;
-                }
+        // Files finish in any order, so the release cover is elected here rather than by whichever track got there
+        // first: the earliest file in upload order that carried artwork
+        const cover = results.find((result) => result?.cover)?.cover;
+        if (cover && !newRelease.coverArtPath) {
+            try {
+                await ImageService.processAndSaveCover(cover, metadataFolder, `release_${newRelease.id}_cover`);
+
+                const coverUrl = `/api/releases/${newRelease.id}/cover`;
+                await db.update(releases)
+                    .set({ coverArtPath: coverUrl })
+                    .where(eq(releases.id, newRelease.id));
+
+                newRelease.coverArtPath = coverUrl;
+            } catch (e) {
+                logger.warn(`Failed to save release cover from track artwork: ${e}`);
             }
         }
 
@@ -6,11 +6,10 @@ import path from 'node:path';
 import fsp from 'node:fs/promises';
 import fs from 'node:fs';
 import { playlistItems, trackMetadata, tracks } from '#db/schema';
-import { parseFile } from 'music-metadata';
 import { eq, type InferSelectModel, desc } from 'drizzle-orm';
 import { logger } from '../utils/logger.ts';
 import { isUUID } from '../utils/isUUID.ts';
-import { stripCoverArt } from '../utils/stripCoverArt.ts';
+import { probeTrack, stripCoverArt } from '../utils/probeTrack.ts';
 import { $rootDir } from '@sonic-atlas/shared';
 import { generateHLS } from '../utils/pretranscode.ts';
 import { ImageService } from '../services/ImageService.ts';
@@ -173,33 +172,33 @@ router.post('/upload', upload.single('audio'), async (req, res) => {
     let trackInfo: InferSelectModel<typeof tracks> | undefined = undefined;
 
     try {
-        const metadata = await parseFile(req.file.path);
+        const probe = await probeTrack(req.file.path);
         const ext = path.extname(req.file.originalname).slice(1).toLowerCase() as any;
 
-        const albumName = metadata.common.album?.trim() || null;
+        const albumName = probe.tags.album?.trim() || null;
         const albumArtist =
-            metadata.common.albumartist?.trim() ||
-            metadata.common.artist?.trim() ||
+            probe.tags.albumArtist?.trim() ||
+            probe.tags.artist?.trim() ||
             'Unknown Artist';
 
-        logger.info(`Parsed metadata - Album: "${albumName}", AlbumArtist: "${albumArtist}", Title: "${metadata.common.title}"`);
+        logger.info(`Parsed metadata - Album: "${albumName}", AlbumArtist: "${albumArtist}", Title: "${probe.tags.title}"`);
 
         const meta = {
             // tracks
-            duration: metadata.format.duration ? Math.round(metadata.format.duration) : null,
-            sampleRate: metadata.format.sampleRate ?? null,
-            bitDepth: metadata.format.bitsPerSample ?? null,
+            duration: probe.duration ? Math.round(probe.duration) : null,
+            sampleRate: probe.sampleRate,
+            bitDepth: probe.bitDepth,
             format: ext,
 
             // track_metadata
-            title: metadata.common.title ?? path.parse(req.file.originalname).name,
-            artist: metadata.common.artist ?? 'Unknown Artist',
+            title: probe.tags.title ?? path.parse(req.file.originalname).name,
+            artist: probe.tags.artist ?? 'Unknown Artist',
             album: albumName,
             albumArtist,
-            year: metadata.common.year ?? null,
-            genres: metadata.common.genre ?? null,
-            bitrate: metadata.format.bitrate ?? null,
-            codec: metadata.format.codec ?? null
+            year: probe.tags.year,
+            genres: probe.tags.genres,
+            bitrate: probe.bitrate,
+            codec: probe.codec
         }
 
         logger.info(ext);
@@ -223,7 +222,9 @@ router.post('/upload', upload.single('audio'), async (req, res) => {
             await fsp.rename(req.file!.path, newPath);
             fileRenamed = true;
 
-            await stripCoverArt(newPath);
+            if (probe.cover) {
+                await stripCoverArt(newPath);
+            }
 
             await tx
                 .update(tracks)
@@ -243,22 +244,20 @@ router.post('/upload', upload.single('audio'), async (req, res) => {
             return track;
         });
 
-        if (metadata.common.picture && metadata.common.picture.length > 0) {
+        const cover = probe.cover;
+        if (cover) {
             try {
-                const picture = metadata.common.picture[0];
-                if (picture && picture.data) {
-                    const metadataFolder = path.join($rootDir, process.env.STORAGE_PATH || 'storage', 'metadata');
+                const metadataFolder = path.join($rootDir, process.env.STORAGE_PATH || 'storage', 'metadata');
 
-                    const coverName = `${trackInfo!.id}_cover`;
-                    await ImageService.processAndSaveCover(Buffer.from(picture.data), metadataFolder, coverName);
+                const coverName = `${trackInfo!.id}_cover`;
+                await ImageService.processAndSaveCover(cover, metadataFolder, coverName);
 
-                    await db
-                        .update(tracks)
-                        .set({ coverArtPath: `/api/metadata/${trackInfo!.id}/cover` })
-                        .where(eq(tracks.id, trackInfo!.id));
+                await db
+                    .update(tracks)
+                    .set({ coverArtPath: `/api/metadata/${trackInfo!.id}/cover` })
+                    .where(eq(tracks.id, trackInfo!.id));
 
-                    logger.info(`Extracted and processed cover art for track ${trackInfo!.id}`);
-                }
+                logger.info(`Extracted and processed cover art for track ${trackInfo!.id}`);
             } catch (coverErr) {
                 logger.warn(`Failed to extract cover art: ${coverErr}`);
             }
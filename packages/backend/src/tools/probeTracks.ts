@@ -0,0 +1,64 @@
+// Probes every audio file under a directory on a bounded pool and prints one JSON line per file: the tags,
+// duration, sample rate and bit depth the upload pipeline stores. With --strip, an audio-only copy and the
+// embedded cover of each file are written to the given directory, the same way uploads handle them.
+//
+//   node --conditions development src/tools/probeTracks.ts <dir> [--jobs 4] [--strip <out dir>]
+
+import fsp from 'node:fs/promises';
+import os from 'node:os';
+import path from 'node:path';
+import { trackFormatEnum } from '#db/schema';
+import { mapPool, probeTrack, stripCoverArt } from '../utils/probeTrack.ts';
+
+function option(name: string): string | undefined {
+    const index = process.argv.indexOf(`--${name}`);
+    return index >= 0 ? process.argv[index + 1] : undefined;
+}
+
+async function listAudio(dir: string): Promise<string[]> {
+    const entries = await fsp.readdir(dir, { recursive: true, withFileTypes: true });
+    const formats = trackFormatEnum.enumValues as readonly string[];
+
+    return entries
+        .filter((entry) => entry.isFile() && formats.includes(path.extname(entry.name).slice(1).toLowerCase()))
+        .map((entry) => path.join(entry.parentPath, entry.name))
+        .sort();
+}
+
+async function processFile(file: string, stripDir: string | undefined) {
+    const { cover, ...probe } = await probeTrack(file);
+    if (!stripDir || !cover) {
+        return { ...probe, hasCover: cover !== null, stripped: null, cover: null };
+    }
+
+    const stripped = path.join(stripDir, path.basename(file));
+    await fsp.copyFile(file, stripped);
+    await stripCoverArt(stripped);
+
+    const coverPath = `${stripped}.cover`;
+    await fsp.writeFile(coverPath, cover);
+    return { ...probe, hasCover: true, stripped, cover: coverPath };
+}
+
+const root = process.argv[2];
+if (!root || root.startsWith('--')) {
+    console.error('Usage: probeTracks.ts <dir> [--jobs N] [--strip <out dir>]');
+    process.exit(2);
+}
+
+const jobs = Number(option('jobs')) || os.availableParallelism();
+const stripDir = option('strip');
+if (stripDir) await fsp.mkdir(stripDir, { recursive: true });
+
+let failed = 0;
+await mapPool(await listAudio(root), jobs, async (file) => {
+    try {
+        const result = await processFile(file, stripDir);
+        process.stdout.write(`${JSON.stringify({ file, ...result })}\n`);
+    } catch (err) {
+        failed++;
+        process.stdout.write(`${JSON.stringify({ file, error: String(err) })}\n`);
+    }
+});
+
+process.exit(failed > 0 ? 1 : 0);
@@ -0,0 +1,39 @@
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+import { hlsArgs, initFilename } from './hlsArgs.ts';
+
+function valueOf(args: string[], flag: string): string | undefined {
+    const index = args.indexOf(flag);
+    return index >= 0 ? args[index + 1] : undefined;
+}
+
+test('a single tier is written to plain paths', () => {
+    // Lossy sources under 320k only map to efficiency
+    const args = hlsArgs('in.mp3', ['efficiency'], true);
+
+    assert.ok(!args.includes('-var_stream_map'));
+    assert.ok(args.every((arg) => !arg.includes('%v')), 'hlsenc leaves %v unexpanded with one variant');
+    assert.equal(valueOf(args, '-hls_fmp4_init_filename'), initFilename);
+    assert.equal(valueOf(args, '-hls_segment_filename'), 'efficiency/segment_%04d.m4s');
+    assert.equal(args.at(-1), 'efficiency/efficiency.m3u8');
+    assert.equal(valueOf(args, '-c:a:0'), 'libopus');
+});
+
+test('a single MPEG-TS tier has no init segment', () => {
+    const args = hlsArgs('in.mp3', ['efficiency'], false);
+
+    assert.ok(!args.includes('-hls_fmp4_init_filename'));
+    assert.equal(valueOf(args, '-hls_segment_filename'), 'efficiency/segment_%04d.ts');
+});
+
+test('several tiers share one run through the variant map', () => {
+    const args = hlsArgs('in.flac', ['efficiency', 'high', 'cd'], true);
+
+    assert.equal(valueOf(args, '-var_stream_map'), 'a:0,name:efficiency a:1,name:high a:2,name:cd');
+    assert.equal(valueOf(args, '-hls_fmp4_init_filename'), 'init_%v.m4a');
+    assert.equal(valueOf(args, '-hls_segment_filename'), '%v/segment_%04d.m4s');
+    assert.equal(args.at(-1), '%v/%v.m3u8');
+    assert.equal(args.filter((arg) => arg === '0:a:0').length, 3);
+    assert.equal(valueOf(args, '-c:a:2'), 'flac');
+    assert.equal(valueOf(args, '-sample_fmt:a:2'), 's16');
+});
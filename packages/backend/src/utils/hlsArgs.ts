@@ -0,0 +1,52 @@
+import type { Quality } from '@sonic-atlas/shared';
+
+export type Tier = Exclude<Quality, 'auto'>;
+
+export const qualities: Record<Tier, { bitrate?: string, codec: string, maxRate?: string, sampleRate?: string, sampleFmt?: string, bufsize?: string, audioBitrate?: string | null }> = {
+    efficiency: { bitrate: '128k', codec: 'libopus', maxRate: '128k', bufsize: '256k' },
+    high: { bitrate: '320k', codec: 'libopus', maxRate: '320k', bufsize: '640k' },
+    cd: { codec: 'flac', sampleRate: '44100', sampleFmt: 's16', audioBitrate: null },
+    hires: { codec: 'flac', audioBitrate: null }
+}
+
+// Every tier keeps its own init segment under this name, next to its playlist
+export const initFilename = 'init.m4a';
+
+// All tiers come out of one ffmpeg run: the original is demuxed and decoded once and the PCM is fanned out to one
+// encoder per tier (run on their own threads by ffmpeg 7+), with the HLS muxer writing every variant via -var_stream_map.
+function tierArgs(index: number, opts: typeof qualities[Tier]): string[] {
+    return [
+        '-map', '0:a:0',
+        `-c:a:${index}`, opts.codec,
+        ...(opts.bitrate ? [`-b:a:${index}`, opts.bitrate] : []),
+        ...(opts.sampleRate ? [`-ar:a:${index}`, opts.sampleRate] : []),
+        ...(opts.sampleFmt ? [`-sample_fmt:a:${index}`, opts.sampleFmt] : []),
+    ];
+}
+
+/**
+ * The ffmpeg arguments that package `tiers` from `inputFile`, relative to the track's output directory. hlsenc only
+ * expands %v with more than one variant stream, so a single tier is written to plain paths without -var_stream_map.
+ * Several tiers get per-variant init names (the muxer would write them all to the same file otherwise), which
+ * generateHLS renames to initFilename once ffmpeg is done.
+ */
+export function hlsArgs(inputFile: string, tiers: readonly Tier[], useFmp4: boolean): string[] {
+    const single = tiers.length === 1 ? tiers[0] : undefined;
+    const variant = single ?? '%v';
+
+    return [
+        '-i', inputFile,
+        '-vn',
+        ...tiers.flatMap((quality, index) => tierArgs(index, qualities[quality])),
+        '-f', 'hls',
+        '-hls_time', '10',
+        '-hls_playlist_type', 'vod',
+        ...(useFmp4 ? [
+            '-hls_segment_type', 'fmp4',
+            '-hls_fmp4_init_filename', single ? initFilename : 'init_%v.m4a'
+        ] : []),
+        '-hls_segment_filename', `${variant}/segment_%04d.${useFmp4 ? 'm4s' : 'ts'}`,
+        ...(single ? [] : ['-var_stream_map', tiers.map((quality, index) => `a:${index},name:${quality}`).join(' ')]),
+        `${variant}/${variant}.m3u8`
+    ];
+}
@@ -1,103 +1,105 @@
 import { spawn } from 'node:child_process';
 import fs from 'node:fs';
 import path from 'node:path';
-import { $rootDir, type Quality } from '@sonic-atlas/shared';
+import { $rootDir } from '@sonic-atlas/shared';
 import { logger } from './logger.ts';
 import type { InferSelectModel } from 'drizzle-orm';
 import type { tracks } from '#db/schema';
 import { getSourceQuality, qualityHierarchy } from '../routes/stream.ts';
 import { socket } from '../index.ts';
 import { getFolderSize, storageBytes } from '../services/metrics/storageMetrics.ts';
+import { hlsArgs, initFilename, qualities } from './hlsArgs.ts';
 
 const STORAGE_PATH = path.join($rootDir, process.env.STORAGE_PATH || 'storage', 'hls');
 const useFmp4 = Boolean(process.env.HLS_USE_FMP4 ?? true);
 
-const qualities: Record<Exclude<Quality, 'auto'>, { bitrate?: string, codec: string, maxRate?: string, sampleRate?: string, sampleFmt?: string, bufsize?: string, audioBitrate?: string | null }> = {
-    efficiency: { bitrate: '128k', codec: 'libopus', maxRate: '128k', bufsize: '256k' },
-    high: { bitrate: '320k', codec: 'libopus', maxRate: '320k', bufsize: '640k' },
-    cd: { codec: 'flac', sampleRate: '44100', sampleFmt: 's16', audioBitrate: null },
-    hires: { codec: 'flac', audioBitrate: null }
+function parseTime(time: string): number {
+    const [hours, minutes, seconds] = time.split(':').map(Number);
+    return (hours! * 60 + minutes!) * 60 + seconds!;
 }
 
 export async function generateHLS(track: InferSelectModel<typeof tracks>, inputFile: string, socketRoom?: string) {
     const outputDir = path.join(STORAGE_PATH, track.id);
     fs.mkdirSync(outputDir, { recursive: true });
 
-    const variantPlaylists: string[] = [];
-
     const sourceQuality = getSourceQuality(track);
     const sourceIndex = qualityHierarchy.indexOf(sourceQuality);
     const availableQualities = qualityHierarchy.slice(0, sourceIndex + 1);
 
-    for (const [quality, opts] of Object.entries(qualities)) {
-        if (availableQualities.indexOf(quality as Exclude<Quality, 'auto'>) === -1) continue;
+    for (const quality of availableQualities) {
+        fs.mkdirSync(path.join(outputDir, quality), { recursive: true });
+    }
 
-        const qualityDir = path.join(outputDir, quality);
-        fs.mkdirSync(qualityDir, { recursive: true });
-        const playlistFile = path.join(qualityDir, `${quality}.m3u8`);
+    const ffmpegArgs = hlsArgs(inputFile, availableQualities, useFmp4);
 
-        const ffmpegArgs = [
-            '-i', inputFile,
-            '-vn',
-            '-acodec', opts.codec,
-            ...(opts.bitrate ? ['-b:a', opts.bitrate] : []),
-            ...(opts.sampleRate ? ['-ar', opts.sampleRate] : []),
-            ...(opts.sampleFmt ? ['-sample_fmt', opts.sampleFmt] : []),
-            '-f', 'hls',
-            '-hls_time', '10',
-            '-hls_playlist_type', 'vod',
-            ...(useFmp4 ? [
-                '-hls_segment_type', 'fmp4',
-                '-hls_fmp4_init_filename', 'init.m4a'
-            ] : []),
-            '-hls_segment_filename', `segment_%04d.${useFmp4 ? 'm4s' : 'ts'}`,
-            `${quality}.m3u8`
-        ];
-
-        logger.debug(`Transcoding ${quality} for ${track.id} in directory: ${qualityDir}`);
-        if (socketRoom) {
+    logger.debug(`Transcoding ${availableQualities.join(', ')} for ${track.id} in directory: ${outputDir}`);
+    if (socketRoom) {
+        for (const quality of availableQualities) {
             socket.io.to(socketRoom).emit('startTranscode', {
                 id: track.id,
                 quality
             });
         }
+    }
+
+    const startedAt = performance.now();
+    let encodedSeconds = 0;
 
-        // set current working directory to qualityDir and use just the filename above
-        const ffmpeg = spawn('ffmpeg', ffmpegArgs, { cwd: qualityDir });
+    // set current working directory to outputDir, the variant names above are relative to it
+    const ffmpeg = spawn('ffmpeg', ffmpegArgs, { cwd: outputDir });
 
-        ffmpeg.stderr.on('data', (data) => {
-            const line = data.toString();
-            const match = line.match(/time=(\d+:\d+:\d+\.\d+)/);
-            if (match && socketRoom) {
+    ffmpeg.stderr.on('data', (data) => {
+        const line = data.toString();
+        const match = line.match(/time=(\d+:\d+:\d+\.\d+)/);
+        if (!match) return;
+
+        encodedSeconds = parseTime(match[1]!);
+        if (socketRoom) {
+            for (const quality of availableQualities) {
                 socket.io.to(socketRoom).emit('transcodeProgress', {
                     id: track.id,
                     quality,
                     time: match[1]
                 });
             }
+        }
+    });
+
+    await new Promise((resolve, reject) => {
+        ffmpeg.on('close', (code) => {
+            if (code === 0) {
+                resolve(null);
+            } else {
+                reject(new Error(`FFmpeg exited with code ${code}`));
+            }
         });
+    });
 
-        await new Promise((resolve, reject) => {
-            ffmpeg.on('close', (code) => {
-                if (code === 0) {
-                    resolve(null);
-                } else {
-                    reject(new Error(`FFmpeg exited with code ${code}`));
-                }
-            });
-        });
+    const elapsedSeconds = (performance.now() - startedAt) / 1000;
+    const duration = track.duration || encodedSeconds;
+
+    for (const quality of availableQualities) {
+        const qualityDir = path.join(outputDir, quality);
+        const playlistFile = path.join(qualityDir, `${quality}.m3u8`);
 
-        if (useFmp4) { // Fix playlist file URI
+        // Keep the per-quality init.m4a layout of earlier uploads, a single tier is already written under it
+        if (useFmp4 && availableQualities.length > 1) {
+            fs.renameSync(path.join(qualityDir, `init_${quality}.m4a`), path.join(qualityDir, initFilename));
             let playlist = fs.readFileSync(playlistFile, 'utf-8');
-            playlist = playlist.replace(/#EXT-X-MAP:URI=".*init\.m4a"/, '#EXT-X-MAP:URI="init.m4a"');
+            playlist = playlist.replace(/#EXT-X-MAP:URI=".*init_[^"]*\.m4a"/, `#EXT-X-MAP:URI="${initFilename}"`);
             fs.writeFileSync(playlistFile, playlist);
         }
 
-        variantPlaylists.push(playlistFile);
-
         const size = await getFolderSize(qualityDir);
         storageBytes.labels({ type: 'hls', quality }).inc(size);
 
+        // The decode is shared, so every tier runs at the same speed; what differs is what it costs to store
+        logger.info(
+            `Packaged ${quality} for ${track.id}: ${(size / 1048576).toFixed(1)} MB, ` +
+            `${duration > 0 ? Math.round(size * 8 / duration / 1000) : 0} kbps, ` +
+            `${elapsedSeconds > 0 ? (duration / elapsedSeconds).toFixed(1) : '?'}x realtime`
+        );
+
         if (socketRoom) {
             socket.io.to(socketRoom).emit('finishTranscode', {
                 id: track.id,
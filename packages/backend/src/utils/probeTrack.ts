@@ -0,0 +1,124 @@
+import { spawn } from 'node:child_process';
+import path from 'node:path';
+import fsp from 'node:fs/promises';
+import { parseFile } from 'music-metadata';
+
+export interface ProbedTrack {
+    duration: number | null;
+    sampleRate: number | null;
+    bitDepth: number | null;
+    lossless: boolean | null;
+    codec: string | null;
+    bitrate: number | null;
+    // The first embedded picture, as stored (JPEG or PNG), left to ImageService
+    cover: Buffer | null;
+    tags: {
+        title: string | null;
+        artist: string | null;
+        albumArtist: string | null;
+        album: string | null;
+        year: number | null;
+        genres: string[] | null;
+        trackNo: number | null;
+        diskNo: number | null;
+    };
+}
+
+function run(command: string, args: string[]): Promise<void> {
+    return new Promise((resolve, reject) => {
+        const child = spawn(command, args);
+        let stderrData = '';
+
+        child.stderr.on('data', (data) => {
+            stderrData += data.toString();
+        });
+
+        child.on('error', reject);
+        child.on('close', (code) => {
+            if (code === 0) {
+                resolve();
+            } else {
+                reject(new Error(`${command} exited with code ${code}: ${stderrData.trim()}`));
+            }
+        });
+    });
+}
+
+/**
+ * Reads tags, duration, sample rate, bit depth and the embedded cover in process. The parse reads the tag and header
+ * blocks (MP3s without a length header also get a frame scan), so files without a cover spawn nothing and the only
+ * second read is the remux in stripCoverArt.
+ */
+export async function probeTrack(filePath: string): Promise<ProbedTrack> {
+    const metadata = await parseFile(filePath, { duration: true });
+    const picture = metadata.common.picture?.[0];
+
+    return {
+        duration: metadata.format.duration ?? null,
+        sampleRate: metadata.format.sampleRate ?? null,
+        // Lossy codecs report no depth, which is what getSourceQuality expects for them
+        bitDepth: metadata.format.bitsPerSample ?? null,
+        lossless: metadata.format.lossless ?? null,
+        codec: metadata.format.codec ?? null,
+        bitrate: metadata.format.bitrate ?? null,
+        cover: picture?.data ? Buffer.from(picture.data) : null,
+        tags: {
+            title: metadata.common.title ?? null,
+            artist: metadata.common.artist ?? null,
+            albumArtist: metadata.common.albumartist ?? null,
+            album: metadata.common.album ?? null,
+            year: metadata.common.year ?? null,
+            genres: metadata.common.genre ?? null,
+            trackNo: metadata.common.track.no ?? null,
+            diskNo: metadata.common.disk.no ?? null,
+        },
+    };
+}
+
+/**
+ * Remuxes the file to audio only in place, dropping its artwork. One ffmpeg run, the audio is copied as is.
+ */
+export async function stripCoverArt(inputPath: string): Promise<void> {
+    const ext = path.extname(inputPath);
+    const tempOutput = `${inputPath}.temp${ext}`;
+
+    try {
+        await run('ffmpeg', [
+            '-v', 'error',
+            '-y',
+            '-i', inputPath,
+            '-map', '0:a',               // Only map audio streams
+            '-c:a', 'copy',              // Copy audio codec (no re-encoding)
+            '-map_metadata', '0',        // Preserve metadata
+            '-map_metadata:s:a', '0:s:a', // Preserve audio stream metadata
+            '-id3v2_version', '3',       // For MP3 files
+            tempOutput
+        ]);
+        await fsp.rename(tempOutput, inputPath);
+    } finally {
+        await fsp.unlink(tempOutput).catch(() => {});
+    }
+}
+
+/**
+ * Runs `fn` over `items` with at most `limit` in flight and returns the results in input order.
+ */
+export async function mapPool<T, R>(items: readonly T[], limit: number, fn: (item: T, index: number) => Promise<R>): Promise<R[]> {
+    const results = new Array<R>(items.length);
+    let next = 0;
+
+    async function worker(): Promise<void> {
+        while (next < items.length) {
+            const index = next++;
+            results[index] = await fn(items[index]!, index);
+        }
+    }
+
+    const workers: Promise<void>[] = [];
+    for (let i = 0; i < Math.min(limit, items.length); i++) {
+        workers.push(worker());
+    }
+    await Promise.all(workers);
+
+    return results;
+}
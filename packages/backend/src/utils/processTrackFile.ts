@@ -4,9 +4,8 @@ import { eq } from 'drizzle-orm';
 import path from 'node:path';
 import fs from 'node:fs';
 import fsp from 'node:fs/promises';
-import { parseFile } from 'music-metadata';
 import { enqueueTranscodeJob } from '../services/transcodeQueue.ts';
-import { stripCoverArt } from './stripCoverArt.ts';
+import { probeTrack, stripCoverArt } from './probeTrack.ts';
 import { $rootDir } from '@sonic-atlas/shared';
 import { ImageService } from '../services/ImageService.ts';
 import { logger } from './logger.ts';
@@ -25,6 +24,9 @@ export interface ProcessTrackOptions {
     socketId?: string;
     extractAllCovers?: boolean;
     existingReleaseCoverPath?: string | null;
+    // Return the cover instead of saving it as the release cover, for callers processing a release concurrently
+    // that elect one once every file is done
+    deferReleaseCover?: boolean;
 }
 
 export interface ProcessedTrack {
@@ -41,6 +43,7 @@ export interface ProcessedTrack {
 export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
     track: ProcessedTrack;
     releaseCoverUrl?: string | undefined;
+    cover?: Buffer | undefined;
 } | null> {
     const {
         filePath,
@@ -51,6 +54,7 @@ export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
         year,
         socketId,
         extractAllCovers = false,
+        deferReleaseCover = false,
     } = opts;
 
     let existingReleaseCoverPath = opts.existingReleaseCoverPath ?? null;
@@ -59,7 +63,7 @@ export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
 
     for (let attempt = 1; attempt <= maxAttempts; attempt++) {
         try {
-            const metadata = await parseFile(filePath, { duration: true });
+            const probe = await probeTrack(filePath);
             const rawExt = path.extname(originalFilename).slice(1).toLowerCase();
             
             if (!(trackFormatEnum.enumValues as readonly string[]).includes(rawExt)) {
@@ -69,17 +73,17 @@ export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
             const ext = rawExt as import('@sonic-atlas/shared').UploadAudioFormat;
 
             const meta = {
-                duration: metadata.format.duration ? Math.max(1, Math.round(metadata.format.duration)) : null,
-                sampleRate: metadata.format.sampleRate ?? null,
-                bitDepth: metadata.format.bitsPerSample ?? null,
+                duration: probe.duration ? Math.max(1, Math.round(probe.duration)) : null,
+                sampleRate: probe.sampleRate,
+                bitDepth: probe.bitDepth,
                 format: ext,
-                title: metadata.common.title ?? path.parse(originalFilename).name,
-                artist: metadata.common.artist ?? primaryArtist ?? 'Unknown Artist',
-                album: metadata.common.album ?? releaseTitle ?? 'Unknown Album',
-                year: metadata.common.year ?? (year ? parseInt(year) : null),
-                genres: metadata.common.genre ?? null,
-                trackNo: metadata.common.track.no ?? null,
-                diskNo: metadata.common.disk.no ?? 1,
+                title: probe.tags.title ?? path.parse(originalFilename).name,
+                artist: probe.tags.artist ?? primaryArtist ?? 'Unknown Artist',
+                album: probe.tags.album ?? releaseTitle ?? 'Unknown Album',
+                year: probe.tags.year ?? (year ? parseInt(year) : null),
+                genres: probe.tags.genres,
+                trackNo: probe.tags.trackNo,
+                diskNo: probe.tags.diskNo ?? 1,
             };
 
             const fileSize = (await fsp.stat(filePath)).size;
@@ -110,7 +114,11 @@ export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
                     throw new Error('Source file not found for processing');
                 }
 
-                await stripCoverArt(newPath);
+                // The cover already came out of the tag parse, a remux is only worth another read when there is
+                // artwork to drop
+                if (probe.cover) {
+                    await stripCoverArt(newPath);
+                }
                 const finalFileSize = (await fsp.stat(newPath)).size;
                 await tx.update(tracks).set({ filename, fileSize: finalFileSize }).where(eq(tracks.id, track.id));
 
@@ -135,38 +143,28 @@ export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
                     genres: meta.genres,
                 });
 
-                if (metadata.common.picture?.length) {
+                const cover = probe.cover;
+                if (cover) {
                     try {
-                        const picture = metadata.common.picture[0];
-                        if (picture?.data) {
-                            if (!existingReleaseCoverPath) {
-                                const releaseCoverName = `release_${releaseId}_cover`;
-                                await ImageService.processAndSaveCover(
-                                    Buffer.from(picture.data),
-                                    metadataFolder,
-                                    releaseCoverName,
-                                );
-
-                                releaseCoverUrl = `/api/releases/${releaseId}/cover`;
-                                existingReleaseCoverPath = releaseCoverUrl;
-
-                                await tx.update(releases)
-                                    .set({ coverArtPath: releaseCoverUrl })
-                                    .where(eq(releases.id, releaseId));
-                            }
-
-                            if (extractAllCovers) {
-                                const trackCoverName = `${track.id}_cover`;
-                                await ImageService.processAndSaveCover(
-                                    Buffer.from(picture.data),
-                                    metadataFolder,
-                                    trackCoverName,
-                                );
-
-                                await tx.update(tracks)
-                                    .set({ coverArtPath: `/api/metadata/${track.id}/cover` })
-                                    .where(eq(tracks.id, track.id));
-                            }
+                        if (!existingReleaseCoverPath && !deferReleaseCover) {
+                            const releaseCoverName = `release_${releaseId}_cover`;
+                            await ImageService.processAndSaveCover(cover, metadataFolder, releaseCoverName);
+
+                            releaseCoverUrl = `/api/releases/${releaseId}/cover`;
+                            existingReleaseCoverPath = releaseCoverUrl;
+
+                            await tx.update(releases)
+                                .set({ coverArtPath: releaseCoverUrl })
+                                .where(eq(releases.id, releaseId));
+                        }
+
+                        if (extractAllCovers) {
+                            const trackCoverName = `${track.id}_cover`;
+                            await ImageService.processAndSaveCover(cover, metadataFolder, trackCoverName);
+
+                            await tx.update(tracks)
+                                .set({ coverArtPath: `/api/metadata/${track.id}/cover` })
+                                .where(eq(tracks.id, track.id));
                         }
                     } catch (e) {
                         logger.warn(`Failed to extract cover art for ${track.id}: ${e}`);
@@ -194,6 +192,7 @@ export async function processTrackFile(opts: ProcessTrackOptions): Promise<{
                     transcodeStatus: 'pending',
                 },
                 releaseCoverUrl,
+                cover: deferReleaseCover ? probe.cover ?? undefined : undefined,
             };
         } catch (err) {
             logger.error(`Failed to process file ${originalFilename} (attempt ${attempt}/${maxAttempts}): ${err}`);